@@ -13,6 +13,8 @@ namespace go {
 
     class Board {
     public:
+        static constexpr int MaxSize = 25;  // bounds the scratch space of the const queries
+
         explicit Board(int n, double komi);
 
         int size() const noexcept {
@@ -27,10 +29,18 @@ namespace go {
             return board_[(y + 1) * stride_ + x + 1];
         };
 
+        int point(int x, int y) const noexcept {
+            return (y + 1) * stride_ + x + 1;
+        }
+
         Color to_play() const noexcept {
             return to_play_;
         }
 
+        double komi() const noexcept {
+            return komi_;
+        }
+
         int ply_count() const noexcept {
             return static_cast<int>(history_.size());
         }
@@ -43,32 +53,67 @@ namespace go {
             return ko_age_;
         }
 
+        uint64_t hash() const noexcept;
+
         std::array<int, 4> neigh4(int v) const;
         std::array<int, 4> diag_neigh(int v) const;
         std::array<int, 8> neigh8(int v) const;
 
         std::pair<std::array<int, 18>, int> last_moves_neigh() const;
 
+        // Dihedral transforms: bit 1 mirrors x, bit 2 mirrors y, bit 4 swaps x and y.
+        int transform(int v, int sym) const noexcept;
+        int symmetries() const;  // mask of transforms leaving the position unchanged
+        bool is_canonical(int v, int symmetries) const noexcept;
+
         bool move(Move m);
+        bool play_as(Color c, Move m);  // passes first if c is not to play
         void undo(int count = 1);
 
         void gen_pseudo_legal_moves(std::vector<Move>& moves) const;
+        // Also fills the legality cache. Eyes of either color are left out, or
+        // only the mover's own with own_eyes_only.
+        void gen_legal_moves(std::vector<Move>& moves, bool own_eyes_only = false);
+
+        // Side-effect free queries for the player to move; safe to call from
+        // several threads while nobody moves on the board.
+        bool is_legal(Move m) const;
+        int captures(Move m) const;  // number of stones the move would capture
+        bool is_self_atari(Move m) const;
+
+        bool is_capture(Move m) const {
+            return captures(m) > 0;
+        }
 
-        bool is_capture(Move m);
+        // Writes up to libs.size() liberties of the group at v, returns how many were found.
+        int liberties(int v, std::span<int> libs) const;
 
         double evaluate(Color perspective) const;
 
+        std::string coord(Move m) const;
         std::string dump(bool flip_vertical = true) const;
 
     private:
         int n_, stride_;
         int ko_point_ = -1, ko_age_ = -1;
         double komi_;
+        uint64_t hash_;  // stones only, see hash()
         std::vector<Point> board_;
         std::vector<Undo> history_;
         std::vector<int> capture_pool_;
         Color to_play_ = Color::Black;
 
+        // Per point legality for each color, ignoring ko, valid for the position
+        // after legal_ply_ moves. Moves leave it alone; gen_legal_moves() clears
+        // the points around everything played since and refills them, and undo()
+        // clears the points around the undone moves it rolls back past.
+        std::vector<std::uint8_t> legal_;
+        int legal_ply_ = 0;
+
+        bool compute_legal(int v, Color c) const;
+        void sync_legality();
+        void invalidate_legality(int from, int to);  // around the moves history_[from, to)
+
         std::span<const int> captured_span(const Undo& u) const noexcept;
 
         std::optional<Color> is_eyeish(int v) const;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <istream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <optional>
+
+#include "types.h"
+#include "board.h"
+
+namespace go {
+
+    struct SgfMove {
+        Color color;
+        int x = -1;  // x < 0 is a pass
+        int y = -1;  // 0 is the bottom row, as in Board::at
+    };
+
+    struct SgfGame {
+        int size = 19;
+        double komi = 0;
+        std::string result;
+        std::optional<Color> to_play;  // PL
+        std::vector<SgfMove> setup;  // AB / AW stones
+        std::vector<SgfMove> moves;  // main line only
+    };
+
+    // Reads games from an SGF collection one at a time, so a corpus of any
+    // size is parsed with memory bounded by the largest single game.
+    class SgfReader {
+    public:
+        explicit SgfReader(std::istream& in) : in_(in) {}
+
+        std::optional<SgfGame> next();
+
+    private:
+        std::istream& in_;
+        // AB / AW / B / W values of the node being read, converted once the
+        // node is done as the root may give SZ after them
+        std::vector<std::pair<std::string, std::string>> points_;
+
+        int peek_token();
+        bool read_value(std::string& value);
+        void skip_tree();
+        void read_node(SgfGame& game, bool root);
+    };
+
+    // The setup stones placed, with PL to play when given.
+    Board start_position(const SgfGame& game);
+
+    // False for points off the board and illegal moves.
+    bool play(Board& board, const SgfMove& m);
+
+}  // namespace go
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 namespace go {
 
@@ -32,6 +33,18 @@ namespace go {
         return p == ToPoint(c);
     }
 
+    // Fixed keys, so hashes are stable across processes and runs.
+    inline uint64_t Mix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    inline uint64_t ZobristKey(int v, Point p) {
+        return Mix64(static_cast<uint64_t>(v) * 4 + static_cast<uint64_t>(p));
+    }
+
     struct Move {
         int v;
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <cstddef>
+
+namespace mcts {
+
+    struct BatchOptions {
+        int threads = static_cast<int>(std::thread::hardware_concurrency());
+        int iters = 2000;
+        int min_ply = 0;
+        int max_ply = std::numeric_limits<int>::max();
+        int every = 1;  // analyze every n-th position of a game
+        std::size_t queue_capacity = 1024;  // positions buffered ahead of the workers
+        uint64_t seed = std::random_device{}();
+    };
+
+    struct BatchStats {
+        long games = 0;
+        long positions = 0;
+    };
+
+    // Streams games from an SGF collection and searches each selected position
+    // on a pool of workers, each owning its own MCTS. Every result is written as
+    // one tab-separated line:
+    //   game  ply  to_play  best_move  win_rate  visits
+    // Lines appear in completion order, not input order.
+    BatchStats analyze_sgf(std::istream& in, std::ostream& out, const BatchOptions& opts = {});
+
+}  // namespace mcts
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "go/types.h"
+#include "mcts/node.h"
+
+namespace mcts {
+
+    // Disk-backed table of root child statistics keyed by go::Board::hash().
+    // The file is memory-mapped, so opening a book costs no parsing, and any
+    // number of processes can read the same book at once.
+    class Book {
+    public:
+        static constexpr int MaxMoves = 8;
+
+        struct BookMove {
+            int32_t v;  // point, see go::Move
+            uint32_t visits;
+            uint32_t wins;
+        };
+
+        struct Entry {
+            uint64_t key;  // 0 marks an empty slot
+            uint32_t count;
+            uint32_t reserved;
+            std::array<BookMove, MaxMoves> moves;  // sorted by visits, best first
+        };
+
+        Book() = default;
+        ~Book();
+
+        Book(const Book&) = delete;
+        Book& operator=(const Book&) = delete;
+
+        bool create(const std::string& path, std::size_t capacity);
+        bool open(const std::string& path, bool writable = false);
+        void close();
+
+        bool is_open() const noexcept {
+            return entries_ != nullptr;
+        }
+
+        std::size_t capacity() const noexcept {
+            return capacity_;
+        }
+
+        const Entry* probe(uint64_t key) const;
+
+        // Accumulates stats into the entry for key, keeping the most visited moves.
+        bool store(uint64_t key, const std::vector<MoveStats>& stats);
+
+        // Adds every entry of other into this book.
+        bool merge(const Book& other);
+
+    private:
+        struct Header;
+
+        void* map_ = nullptr;
+        std::size_t map_size_ = 0;
+        std::size_t capacity_ = 0;
+        bool writable_ = false;
+        Entry* entries_ = nullptr;
+
+        bool map_file(int fd, std::size_t size, bool writable);
+        Entry* find_slot(uint64_t key) const;
+    };
+
+}  // namespace mcts
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+
+#include "go/types.h"
+#include "go/board.h"
+
+namespace mcts {
+
+    // Alpha-beta solver for positions with only a few points left to play.
+    // Players choose among the legal moves that do not fill one of their own
+    // eyes, captures inside the opponent's eyes included, or pass, and the
+    // game ends after two passes with Board::evaluate. Self-ataris that
+    // capture nothing are left out too: throw-ins and their recaptures make
+    // lines of any length. Scores are exact for this game, which misses
+    // throw-in tactics such as false eyes and snapbacks; lines longer than
+    // 64 plies give up on the position.
+    // Moves repeating a position of the current line are not tried. Results
+    // are kept in a transposition table across calls, keyed on komi too; a
+    // result that depends on the line above it, as a move back to a position
+    // of that line was skipped, is not kept.
+    class EndgameSolver {
+    public:
+        explicit EndgameSolver(int max_nodes = 5000, std::size_t table_size = 1 << 16);
+
+        // Moves left to the player with more of them, the size of the problem.
+        int count_relevant(go::Board& pos);
+
+        // Exact score for the player to move, or nullopt when the position
+        // needs more than max_nodes nodes.
+        std::optional<double> solve(go::Board& pos, go::Move* best = nullptr);
+
+    private:
+        enum class Bound : std::uint8_t {
+            Exact,
+            Lower,
+            Upper,
+            Unsolved
+        };
+
+        struct Entry {
+            uint64_t key = 0;
+            double score = 0;
+            int best = -1;
+            Bound bound = Bound::Exact;
+        };
+
+        std::vector<Entry> table_;
+        std::vector<std::vector<go::Move>> moves_;  // one buffer per depth
+        std::vector<uint64_t> path_;  // hashes of the positions on the current line
+        uint64_t komi_key_ = 0;
+        int repeated_ = 0;  // index in path_ of the earliest position repeated below the current node
+        int max_nodes_;
+        int nodes_ = 0;
+        bool aborted_ = false;
+
+        void gen_moves(go::Board& pos, std::vector<go::Move>& moves);
+        double negamax(go::Board& pos, double alpha, double beta, int passes, int depth, go::Move* best);
+        Entry& slot(uint64_t key);
+    };
+
+}  // namespace mcts
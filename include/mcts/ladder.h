@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "go/types.h"
+#include "go/board.h"
+
+namespace mcts {
+
+    // Reads ladders against groups with one or two liberties using Board::move/undo.
+    // A result is cached per point together with the rectangle the reading looked
+    // at and a hash of the stones inside it, so it stays valid until a move lands
+    // near the ladder path. No allocations happen after construction.
+    class LadderReader {
+    public:
+        LadderReader();
+
+        // Whether the group at v dies in a ladder with the player to move in pos:
+        // its owner tries to escape an atari, the opponent tries to capture a
+        // group with two liberties.
+        bool is_captured(go::Board& pos, int v);
+
+    private:
+        struct Entry {
+            uint64_t hash = 0;
+            int size = 0;  // 0 marks an empty entry
+            go::Color to_play;
+            int x0, y0, x1, y1;
+            bool captured;
+        };
+
+        std::vector<Entry> cache_;
+
+        // scratch for the group scans, marked like Board::mark_
+        std::vector<int> mark_;
+        int mark_id_ = 0;
+        std::vector<int> stack_;
+        std::vector<int> adjacent_;
+        std::vector<int> escapes_;  // capturing escapes, one frame per defend() on the stack
+
+        int stride_ = 0;
+        std::vector<int8_t> xs_, ys_;  // point coordinates for the current stride
+        int x0_, y0_, x1_, y1_;  // region inspected by the current reading
+
+        void cover(int v);
+        int scan(const go::Board& pos, int v, int limit, int* libs, bool collect_adjacent = false);
+        void cover_move(const go::Board& pos, int v, int covered_mark);
+        uint64_t region_hash(const go::Board& pos, int x0, int y0, int x1, int y1) const;
+
+        bool defend(go::Board& pos, int v, int depth);
+        bool try_escape(go::Board& pos, int v, int m, int group_mark, int depth);  // true if the group still dies
+        bool attack(go::Board& pos, int v, int lib1, int lib2, int group_mark, int depth);
+    };
+
+}  // namespace mcts
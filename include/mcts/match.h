@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <optional>
+#include <sys/types.h>
+
+#include "go/types.h"
+#include "go/board.h"
+#include "mcts/mcts.h"
+
+namespace mcts {
+
+    // One side of a match. genmove answers nullopt to resign.
+    class Player {
+    public:
+        virtual ~Player() = default;
+
+        virtual void new_game(int size, double komi) = 0;
+        virtual void play(const go::Board& pos, go::Move m) = 0;  // pos is before the move
+        virtual std::optional<go::Move> genmove(const go::Board& pos, std::chrono::milliseconds time) = 0;
+    };
+
+    // The engine of this build, searching until the time for the move is up.
+    class MCTSPlayer : public Player {
+    public:
+        explicit MCTSPlayer(uint64_t seed) : engine_(seed) {}
+
+        MCTS& engine() noexcept {
+            return engine_;
+        }
+
+        void new_game(int, double) override {}
+        void play(const go::Board&, go::Move) override {}
+        std::optional<go::Move> genmove(const go::Board& pos, std::chrono::milliseconds time) override;
+
+    private:
+        MCTS engine_;
+    };
+
+    // Any engine speaking GTP on stdin/stdout, typically another build
+    // running serve_gtp. The command is run with /bin/sh -c, talking over a
+    // socket pair so that an engine that died fails the next command rather
+    // than raising SIGPIPE.
+    class GtpPlayer : public Player {
+    public:
+        GtpPlayer() = default;
+        ~GtpPlayer() override;
+
+        GtpPlayer(const GtpPlayer&) = delete;
+        GtpPlayer& operator=(const GtpPlayer&) = delete;
+
+        bool start(const std::string& command);
+        void stop();
+
+        void new_game(int size, double komi) override;
+        void play(const go::Board& pos, go::Move m) override;
+        std::optional<go::Move> genmove(const go::Board& pos, std::chrono::milliseconds time) override;
+
+    private:
+        pid_t pid_ = -1;
+        int socket_ = -1;  // written with send, read through from_engine_
+        std::FILE* from_engine_ = nullptr;
+
+        std::optional<std::string> send(const std::string& command);  // the response without "= "
+    };
+
+    struct MatchOptions {
+        int games = 100;
+        int size = 9;
+        double komi = 7;
+        std::chrono::milliseconds move_time{1000};  // the same for both players
+        int max_moves = 0;  // 0 means 3 * size * size
+    };
+
+    struct MatchStats {
+        int games = 0;
+        int first_wins = 0;
+        int second_wins = 0;
+    };
+
+    // Plays games between two players, alternating who takes black. A game
+    // ends after two passes and is scored with Board::evaluate; resigning or
+    // an illegal move loses. Writes one tab-separated line per game:
+    //   game  black  winner  score  moves
+    // with black and winner given as "first" or "second".
+    MatchStats play_match(Player& first, Player& second, std::ostream& log, const MatchOptions& opts = {});
+
+    // Answers GTP commands from in on out until quit or end of input, so that
+    // a build can take part in a match as a GtpPlayer.
+    void serve_gtp(std::istream& in, std::ostream& out, MCTS& engine);
+
+}  // namespace mcts
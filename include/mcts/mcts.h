@@ -5,10 +5,19 @@
 #include <string>
 #include <limits>
 #include <random>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <utility>
+#include <functional>
 
 #include "go/types.h"
 #include "go/board.h"
 #include "mcts/node.h"
+#include "mcts/book.h"
+#include "mcts/ladder.h"
+#include "mcts/endgame.h"
 #include "mcts/playout.h"
 
 namespace mcts {
@@ -17,17 +26,73 @@ namespace mcts {
     public:
         explicit MCTS(uint64_t seed = std::random_device{}()) : rng_(seed) {}
 
+        void set_book(const Book* book) noexcept {
+            book_ = book;
+        }
+
+        // Positions where neither player has more than this many moves left
+        // are given to the EndgameSolver, and solved nodes stop running
+        // playouts; 0 turns the solver off. Past a few points most tries run
+        // out of nodes.
+        void set_endgame_points(int points) noexcept {
+            endgame_points_ = points;
+        }
+
+        // Calls fn from search() every interval iterations, between two of them.
+        void set_periodic(std::function<void(MCTS&)> fn, int interval) {
+            periodic_ = std::move(fn);
+            periodic_interval_ = interval;
+        }
+
+        // Calls fn from search() with the analysis of the top_moves most visited
+        // root moves about every interval, and once when the search ends. fn runs
+        // on the searching thread and should hand the snapshot off quickly.
+        void set_analysis(std::function<void(const Analysis&)> fn, std::chrono::milliseconds interval,
+                          int top_moves = 5) {
+            analysis_ = std::move(fn);
+            analysis_interval_ = interval;
+            analysis_moves_ = top_moves;
+        }
+
+        // Makes the running search return its current best move soon; safe to
+        // call from any thread. Searches started after the call are not affected.
+        void stop() noexcept {
+            stopped_.store(started_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
         go::Move search(go::Board root, int iters);
+        go::Move search(go::Board root, int iters, std::chrono::steady_clock::time_point deadline);
+
+        Analysis analysis(int top_moves) const;
+
+        std::vector<MoveStats> root_stats() const;
+        void add_root_priors(const std::vector<MoveStats>& stats);  // unscaled, e.g. from other searches
 
     private:
         std::vector<Node> nodes_;
 
         RNG rng_;
+        LadderReader ladders_;
+        const Book* book_ = nullptr;
+        EndgameSolver endgame_;
+        int endgame_points_ = 4;
+        std::function<void(MCTS&)> periodic_;
+        int periodic_interval_ = 0;
+        std::function<void(const Analysis&)> analysis_;
+        std::chrono::milliseconds analysis_interval_{0};
+        int analysis_moves_ = 0;
+        std::atomic<uint32_t> started_{0};  // searches started, the id of the latest
+        std::atomic<uint32_t> stopped_{0};  // id of the last search stop() was called for
+
+        bool seed_from_book(go::Board& pos);
+        std::optional<double> solve_endgame(go::Board& pos, go::Move* best = nullptr);
+        void add_priors(int node_id, const std::vector<MoveStats>& stats, int max_prior);
 
         int select_child(int parent_id);
 
         int descend(go::Board& pos, std::vector<go::Point>& amaf_map);
         void expand(int node_id, go::Board& pos);
+        void add_tactical_prior(Node& child, go::Board& pos);
         double playout(go::Board& pos, std::vector<go::Point>& amaf_map);
         void backprop(int node_id, double score, const std::vector<go::Point>& amaf_map);
     };
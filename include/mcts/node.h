@@ -20,6 +20,27 @@ namespace mcts {
         int aw = 0;
         int pv = 10;
         int pw = 5;
+
+        bool solved = false;
+        double score = 0;  // exact score for the player to move, once solved
+    };
+
+    struct MoveStats {
+        go::Move move;
+        int v = 0;
+        int w = 0;  // wins for the player making the move
+    };
+
+    struct MoveAnalysis {
+        go::Move move;
+        int visits = 0;
+        double winrate = 0;  // for the player making the move
+        std::vector<go::Move> pv;  // starting with move
+    };
+
+    struct Analysis {
+        int visits = 0;  // of the root
+        std::vector<MoveAnalysis> moves;  // most visited first
     };
 
 }  // namespace mcts
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <thread>
+#include <random>
+#include <vector>
+#include <cstdint>
+
+#include "go/types.h"
+#include "go/board.h"
+#include "mcts/node.h"
+#include "mcts/book.h"
+
+namespace mcts {
+
+    struct RootParallelOptions {
+        int workers = static_cast<int>(std::thread::hardware_concurrency());
+        int iters = 20000;  // per worker
+        int sync_interval = 1000;  // iterations between exchanges of root statistics
+        uint64_t seed = std::random_device{}();
+        const Book* book = nullptr;
+    };
+
+    // Root parallel search: every worker is a forked process growing its own
+    // tree from root with its own seed, so the trees share no memory and no
+    // cache lines. Every sync_interval iterations a worker publishes the visits
+    // and wins of its root children to its slot in a shared anonymous mapping
+    // and adds what the others published as priors of its own root children.
+    // Each slot has a single writer and is read under a sequence counter, so
+    // the exchange takes no locks. The move with the most visits summed over
+    // all workers is returned; merged receives the summed root statistics.
+    go::Move root_parallel_search(const go::Board& root, const RootParallelOptions& opts,
+                                  std::vector<MoveStats>* merged = nullptr);
+
+}  // namespace mcts
@@ -5,6 +5,7 @@
 
 #include "go/types.h"
 #include "go/board.h"
+#include "mcts/ladder.h"
 
 namespace mcts {
 
@@ -14,6 +15,8 @@ namespace mcts {
 
     void gen_playout_moves_capture(go::Board& pos, std::vector<go::Move>& moves);
 
-    go::Move play_heuristic_move(go::Board& pos, RNG& rng);
+    void gen_playout_moves_atari(go::Board& pos, std::vector<go::Move>& moves, LadderReader& ladders);
+
+    go::Move play_heuristic_move(go::Board& pos, RNG& rng, LadderReader& ladders);
 
 }  // namespace mcts
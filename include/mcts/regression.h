@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+#include "go/types.h"
+#include "go/board.h"
+
+namespace mcts {
+
+    // A position with known best moves, drawn as rows from the top of the
+    // board: 'X' black, 'O' white, '.' empty.
+    struct TestPosition {
+        std::string name;
+        double komi = 0;
+        go::Color to_play = go::Color::Black;
+        std::vector<std::string> rows;
+        std::vector<std::string> answers;  // accepted moves as Board::coord writes them
+    };
+
+    go::Board setup_position(const TestPosition& position);
+
+    // The position under one of the dihedral transforms of Board::transform,
+    // answers included, named after it as "name/sym".
+    TestPosition transformed(const TestPosition& position, int sym);
+
+    // Life-and-death, capturing and endgame problems on small boards.
+    const std::vector<TestPosition>& standard_suite();
+
+    struct SuiteOptions {
+        int min_iters = 1;
+        int max_iters = 64000;
+        int seeds = 3;  // each position is searched with seeds seed, seed + 1, ...
+        uint64_t seed = 1;
+    };
+
+    struct SuiteStats {
+        int runs = 0;
+        int settled = 0;
+        long iters = 0;  // sums over the settled runs
+        double seconds = 0;
+    };
+
+    // Searches every position with a fresh MCTS and an iteration budget that
+    // doubles from min_iters until the answer is found at two budgets in a
+    // row. Writes one tab-separated line per position and seed:
+    //   name  seed  settled  iters  seconds  move
+    // where iters and seconds are those of the first of the two searches and
+    // move is the answer of the last search made.
+    SuiteStats run_suite(const std::vector<TestPosition>& positions, std::ostream& out, const SuiteOptions& opts = {});
+
+}  // namespace mcts
@@ -1,10 +1,60 @@
 #include "go/board.h"
 
+#include <bitset>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 namespace {
 
+    constexpr int MAX_POINTS = (go::Board::MaxSize + 2) * (go::Board::MaxSize + 2);
+
+    using PointSet = std::bitset<MAX_POINTS>;
+
+    struct GroupScan {
+        int liberties = 0;
+        int stones = 0;
+    };
+
+    // Flood fill of the color group containing v. Unlike Board::has_liberty it keeps
+    // all scratch state on the stack, so const queries built on it are re-entrant.
+    // Counts distinct liberties other than skip and stops once limit are found, so
+    // stones may then be only part of the group; points in captured count as liberties.
+    // The liberties found are written to lib_out when given.
+    GroupScan scan_group(const std::vector<go::Point>& board, int stride, int v, go::Point color,
+                         int skip, int limit, PointSet& stones, const PointSet* captured = nullptr,
+                         int* lib_out = nullptr) {
+        GroupScan res;
+        PointSet libs;
+        std::array<int, MAX_POINTS> stack;
+        int top = 0;
+        stack[top++] = v;
+        stones.set(v);
+        while (top > 0) {
+            int cur = stack[--top];
+            res.stones++;
+            for (int neigh : {cur - 1, cur + 1, cur - stride, cur + stride}) {
+                if (neigh == skip || stones.test(neigh) || libs.test(neigh)) {
+                    continue;
+                }
+                go::Point p = board[neigh];
+                if (p == go::Point::Empty || (captured != nullptr && captured->test(neigh))) {
+                    libs.set(neigh);
+                    if (lib_out != nullptr) {
+                        lib_out[res.liberties] = neigh;
+                    }
+                    if (++res.liberties >= limit) {
+                        return res;
+                    }
+                } else if (p == color) {
+                    stones.set(neigh);
+                    stack[top++] = neigh;
+                }
+            }
+        }
+        return res;
+    }
+
     char col_letter(int x) {
         return static_cast<char>('A' + x + (x >= 8 ? 1 : 0));
     }
@@ -26,6 +76,7 @@ namespace go {
         : n_(n),
           komi_(komi),
           stride_(n + 2),
+          hash_(Mix64(n)),
           board_(stride_ * stride_, Point::Wall)
     {
         for (int i = 1; i <= n; i++) {
@@ -34,6 +85,7 @@ namespace go {
             }
         }
         mark_.assign(board_.size(), 0);
+        legal_.assign(board_.size(), 0);
     }
 
     std::array<int, 4> Board::neigh4(int v) const {
@@ -99,6 +151,65 @@ namespace go {
         return {res, size};
     }
 
+    uint64_t Board::hash() const noexcept {
+        uint64_t h = hash_;
+        if (to_play_ == Color::White) {
+            h ^= ZobristKey(0, Point::White);
+        }
+        if (ko_point_ != -1 && ko_age_ == ply_count()) {
+            h ^= ZobristKey(ko_point_, Point::Empty);
+        }
+        return h;
+    }
+
+    int Board::transform(int v, int sym) const noexcept {
+        int x = v % stride_ - 1;
+        int y = v / stride_ - 1;
+        if (sym & 1) {
+            x = n_ - 1 - x;
+        }
+        if (sym & 2) {
+            y = n_ - 1 - y;
+        }
+        if (sym & 4) {
+            std::swap(x, y);
+        }
+        return point(x, y);
+    }
+
+    int Board::symmetries() const {
+        int mask = 1;
+        int ko = ko_age_ == ply_count() ? ko_point_ : -1;
+        for (int sym = 1; sym < 8; sym++) {
+            if (ko != -1 && transform(ko, sym) != ko) {
+                continue;
+            }
+            bool symmetric = true;
+            for (int i = 1; i <= n_ && symmetric; i++) {
+                for (int j = 1; j <= n_; j++) {
+                    int pos = i * stride_ + j;
+                    if (board_[pos] != board_[transform(pos, sym)]) {
+                        symmetric = false;
+                        break;
+                    }
+                }
+            }
+            if (symmetric) {
+                mask |= 1 << sym;
+            }
+        }
+        return mask;
+    }
+
+    bool Board::is_canonical(int v, int symmetries) const noexcept {
+        for (int sym = 1; sym < 8; sym++) {
+            if ((symmetries >> sym & 1) && transform(v, sym) < v) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     std::span<const int> Board::captured_span(const Undo& u) const noexcept {
         return {
             capture_pool_.data() + u.cap_begin,
@@ -106,31 +217,144 @@ namespace go {
         };
     }
 
-    bool Board::is_capture(Move m) {
-        if (m.is_pass()) {
-            return false;
+    bool Board::compute_legal(int v, Color c) const {
+        for (int neigh : neigh4(v)) {
+            if (board_[neigh] == Point::Empty) {
+                return true;
+            }
+        }
+        PointSet seen;
+        for (int neigh : neigh4(v)) {
+            Point p = board_[neigh];
+            if (p == Point::Wall || seen.test(neigh)) {
+                continue;
+            }
+            PointSet group;
+            GroupScan g = scan_group(board_, stride_, neigh, p, v, 1, group);
+            seen |= group;
+            if (Matches(p, c) == (g.liberties > 0)) {  // own group keeps a liberty, or enemy group is captured
+                return true;
+            }
         }
+        return false;
+    }
 
+    bool Board::is_legal(Move m) const {
+        if (m.is_pass()) {
+            return true;
+        }
         if (board_[m.v] != Point::Empty) {
             return false;
         }
-
         if (m.v == ko_point_ && ko_age_ == ply_count()) {  // check simple ko rule
             return false;
         }
+        std::uint8_t known = 1 << (2 * static_cast<int>(to_play_));
+        if (legal_ply_ == ply_count() && (legal_[m.v] & known)) {
+            return legal_[m.v] & (known << 1);
+        }
+        return compute_legal(m.v, to_play_);
+    }
 
-        board_[m.v] = ToPoint(to_play_);
+    int Board::captures(Move m) const {
+        if (!is_legal(m) || m.is_pass()) {
+            return 0;
+        }
+        int count = 0;
+        PointSet seen;
+        for (int neigh : neigh4(m.v)) {
+            if (Matches(board_[neigh], Opp(to_play_)) && !seen.test(neigh)) {
+                PointSet group;
+                GroupScan g = scan_group(board_, stride_, neigh, board_[neigh], m.v, 1, group);
+                seen |= group;
+                if (g.liberties == 0) {
+                    count += g.stones;
+                }
+            }
+        }
+        return count;
+    }
 
+    bool Board::is_self_atari(Move m) const {
+        if (!is_legal(m) || m.is_pass()) {
+            return false;
+        }
+        PointSet captured, seen;
         for (int neigh : neigh4(m.v)) {
-            if (Matches(board_[neigh], Opp(to_play_))) {
-                if (!has_liberty(neigh)) {
-                    board_[m.v] = Point::Empty;
-                    return true;
+            if (Matches(board_[neigh], Opp(to_play_)) && !seen.test(neigh) && !captured.test(neigh)) {
+                PointSet group;
+                GroupScan g = scan_group(board_, stride_, neigh, board_[neigh], m.v, 1, group);
+                (g.liberties == 0 ? captured : seen) |= group;
+            }
+        }
+        PointSet stones;
+        GroupScan g = scan_group(board_, stride_, m.v, ToPoint(to_play_), -1, 2, stones, &captured);
+        return g.liberties < 2;
+    }
+
+    int Board::liberties(int v, std::span<int> libs) const {
+        if (libs.empty() || (board_[v] != Point::Black && board_[v] != Point::White)) {
+            return 0;
+        }
+        PointSet stones;
+        int limit = static_cast<int>(libs.size());
+        return scan_group(board_, stride_, v, board_[v], -1, limit, stones, nullptr, libs.data()).liberties;
+    }
+
+    void Board::sync_legality() {
+        invalidate_legality(legal_ply_, ply_count());
+        legal_ply_ = ply_count();
+    }
+
+    void Board::invalidate_legality(int from, int to) {
+        // Legality of a point only depends on its neighbours and on the liberty counts
+        // of the groups around it. Every group whose liberties differ between the two
+        // positions contains or touches a point changed by the moves in between, so
+        // clearing the liberties of those groups on the current board is enough.
+        // This holds in both directions, after moves and after undoing them.
+        mark_id_++;
+        auto clear_group = [&](int v) {
+            if (mark_[v] == mark_id_) {
+                return;
+            }
+            stack_.clear();
+            stack_.push_back(v);
+            mark_[v] = mark_id_;
+            Point color = board_[v];
+            while (!stack_.empty()) {
+                int cur = stack_.back();
+                stack_.pop_back();
+                for (int neigh : neigh4(cur)) {
+                    if (board_[neigh] == Point::Empty) {
+                        legal_[neigh] = 0;
+                    } else if (mark_[neigh] != mark_id_ && board_[neigh] == color) {
+                        mark_[neigh] = mark_id_;
+                        stack_.push_back(neigh);
+                    }
                 }
             }
+        };
+        auto touch = [&](int v) {
+            legal_[v] = 0;
+            for (int p : {v, v - 1, v + 1, v - stride_, v + stride_}) {
+                if (board_[p] == Point::Empty) {
+                    legal_[p] = 0;
+                } else if (board_[p] != Point::Wall) {
+                    clear_group(p);
+                }
+            }
+        };
+
+        for (int i = from; i < to; i++) {
+            const Undo& u = history_[i];
+            if (u.move.is_pass()) {
+                continue;
+            }
+            touch(u.move.v);
+            for (int cap : captured_span(u)) {
+                touch(cap);
+            }
         }
-        board_[m.v] = Point::Empty;
-        return false;
     }
 
     bool Board::has_liberty(int v) const {
@@ -248,6 +472,11 @@ namespace go {
             return false;
         }
 
+        hash_ ^= ZobristKey(m.v, ToPoint(to_play_));
+        for (int cap : captured_span(u)) {
+            hash_ ^= ZobristKey(cap, ToPoint(Opp(to_play_)));
+        }
+
         if (in_enemy_eye && u.cap_count == 1) {  // update ko point
             ko_point_ = captured_span(u).front();
             ko_age_ = ply_count() + 1;
@@ -258,6 +487,21 @@ namespace go {
         return true;
     }
 
+    bool Board::play_as(Color c, Move m) {
+        bool passed = false;
+        if (to_play_ != c) {
+            move(Move::Pass());
+            passed = true;
+        }
+        if (!move(m)) {
+            if (passed) {
+                undo();
+            }
+            return false;
+        }
+        return true;
+    }
+
     void Board::undo(int count) {
         int size = static_cast<int>(history_.size());
         int new_size = size - count;
@@ -265,12 +509,19 @@ namespace go {
             Undo& u = history_[i];
             if (!u.move.is_pass()) {
                 board_[u.move.v] = Point::Empty;
+                hash_ ^= ZobristKey(u.move.v, ToPoint(u.played));
                 for (int v: captured_span(u)) {
                     board_[v] = ToPoint(Opp(u.played));
+                    hash_ ^= ZobristKey(v, ToPoint(Opp(u.played)));
                 }
             }
         }
 
+        if (legal_ply_ > new_size) {  // the cache describes an undone position, clear around the changes
+            invalidate_legality(new_size, legal_ply_);
+            legal_ply_ = new_size;
+        }
+
         Undo& u = history_[new_size];
         to_play_ = u.played;
         ko_point_ = u.ko_point;
@@ -292,6 +543,31 @@ namespace go {
         }
     }
 
+    void Board::gen_legal_moves(std::vector<Move>& moves, bool own_eyes_only) {
+        moves.clear();
+        sync_legality();
+        std::uint8_t known = 1 << (2 * static_cast<int>(to_play_));
+        bool ko_active = ko_age_ == ply_count();
+        for (int i = 1; i <= n_; i++) {
+            for (int j = 1; j <= n_; j++) {
+                int pos = i * stride_ + j;
+                if (board_[pos] != Point::Empty || (ko_active && pos == ko_point_)) {
+                    continue;
+                }
+                std::optional<Color> eye = is_eye(pos);
+                if (eye && (!own_eyes_only || *eye == to_play_)) {
+                    continue;
+                }
+                if (!(legal_[pos] & known)) {
+                    legal_[pos] |= known | (compute_legal(pos, to_play_) ? known << 1 : 0);
+                }
+                if (legal_[pos] & (known << 1)) {
+                    moves.push_back(Move(pos));
+                }
+            }
+        }
+    }
+
     double Board::evaluate(Color perspective) const {
         double score = 0;
         mark_id_++;
@@ -342,6 +618,15 @@ namespace go {
         return score;
     }
 
+    std::string Board::coord(Move m) const {
+        if (m.is_pass()) {
+            return "pass";
+        }
+        int x = m.v % stride_ - 1;
+        int y = m.v / stride_ - 1;
+        return col_letter(x) + std::to_string(y + 1);
+    }
+
     std::string Board::dump(bool flip_vertical) const {
         std::ostringstream out;
 
@@ -0,0 +1,174 @@
+#include "go/sgf.h"
+
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+    bool parse_point(const std::string& value, int size, int& x, int& y) {
+        if (value.empty() || (value == "tt" && size <= 19)) {
+            x = y = -1;
+            return true;
+        }
+        if (value.size() < 2 || !std::islower(value[0]) || !std::islower(value[1])) {
+            return false;
+        }
+        x = value[0] - 'a';
+        y = size - 1 - (value[1] - 'a');  // SGF counts rows from the top
+        return x < size && y >= 0;
+    }
+
+}
+
+namespace go {
+
+    int SgfReader::peek_token() {
+        int c = in_.peek();
+        while (c != EOF && std::isspace(c)) {
+            in_.get();
+            c = in_.peek();
+        }
+        return c;
+    }
+
+    bool SgfReader::read_value(std::string& value) {
+        value.clear();
+        if (peek_token() != '[') {
+            return false;
+        }
+        in_.get();
+        int c;
+        while ((c = in_.get()) != EOF && c != ']') {
+            if (c == '\\') {
+                c = in_.get();
+                if (c == EOF) {
+                    break;
+                }
+            }
+            value.push_back(static_cast<char>(c));
+        }
+        return true;
+    }
+
+    void SgfReader::skip_tree() {  // called after the opening '('
+        int depth = 1;
+        std::string value;
+        while (depth > 0) {
+            int c = peek_token();
+            if (c == EOF) {
+                return;
+            }
+            if (c == '[') {
+                read_value(value);
+                continue;
+            }
+            in_.get();
+            if (c == '(') {
+                depth++;
+            } else if (c == ')') {
+                depth--;
+            }
+        }
+    }
+
+    void SgfReader::read_node(SgfGame& game, bool root) {
+        std::string ident, value;
+        points_.clear();
+        while (true) {
+            int c = peek_token();
+            if (c == EOF || c == ';' || c == '(' || c == ')') {
+                break;
+            }
+            if (!std::isalpha(c)) {
+                in_.get();
+                continue;
+            }
+            ident.clear();
+            while (std::isalpha(in_.peek())) {
+                ident.push_back(static_cast<char>(in_.get()));
+            }
+            while (read_value(value)) {
+                if (root && ident == "SZ") {
+                    game.size = std::atoi(value.c_str());
+                } else if (root && ident == "KM") {
+                    game.komi = std::atof(value.c_str());
+                } else if (root && ident == "RE") {
+                    game.result = value;
+                } else if (root && ident == "PL" && (value == "B" || value == "W")) {
+                    game.to_play = value == "B" ? Color::Black : Color::White;
+                } else if (ident == "AB" || ident == "AW" || ident == "B" || ident == "W") {
+                    points_.emplace_back(ident, value);
+                }
+            }
+        }
+
+        for (const auto& [name, point] : points_) {
+            int x, y;
+            if (!parse_point(point, game.size, x, y)) {
+                continue;
+            }
+            Color color = name.back() == 'B' ? Color::Black : Color::White;
+            if (name.size() == 2 && x >= 0) {
+                game.setup.push_back({color, x, y});
+            } else if (name.size() == 1) {
+                game.moves.push_back({color, x, y});
+            }
+        }
+    }
+
+    std::optional<SgfGame> SgfReader::next() {
+        int c;
+        while ((c = peek_token()) != EOF && c != '(') {
+            in_.get();
+        }
+        if (c == EOF) {
+            return std::nullopt;
+        }
+        in_.get();
+
+        SgfGame game;
+        bool root = true;
+        int depth = 1;  // follow the first variation at every branch
+        while (depth > 0) {
+            c = peek_token();
+            if (c == EOF) {
+                break;
+            }
+            in_.get();
+            if (c == ';') {
+                read_node(game, root);
+                root = false;
+            } else if (c == '(') {
+                depth++;
+            } else if (c == ')') {
+                depth--;
+                // once the main line of a branch is done, its siblings are skipped
+                while (depth > 0 && peek_token() == '(') {
+                    in_.get();
+                    skip_tree();
+                }
+            }
+        }
+        return game;
+    }
+
+    Board start_position(const SgfGame& game) {
+        Board board(game.size, game.komi);
+        for (const SgfMove& m : game.setup) {
+            play(board, m);
+        }
+        if (game.to_play && board.to_play() != *game.to_play) {
+            board.move(Move::Pass());
+        }
+        return board;
+    }
+
+    bool play(Board& board, const SgfMove& m) {
+        if (m.x >= board.size() || m.y >= board.size() || (m.x < 0) != (m.y < 0)) {
+            return false;
+        }
+        Move move = m.x < 0 ? Move::Pass() : Move(board.point(m.x, m.y));
+        return board.play_as(m.color, move);
+    }
+
+}  // namespace go
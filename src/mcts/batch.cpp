@@ -0,0 +1,133 @@
+#include "mcts/batch.h"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <condition_variable>
+
+#include "go/board.h"
+#include "go/sgf.h"
+#include "mcts/mcts.h"
+
+namespace {
+
+    struct Job {
+        long game;
+        int ply;
+        go::Board pos;
+    };
+
+    class JobQueue {
+    public:
+        explicit JobQueue(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+        void push(Job job) {
+            std::unique_lock lock(mutex_);
+            not_full_.wait(lock, [&] { return jobs_.size() < capacity_; });
+            jobs_.push_back(std::move(job));
+            not_empty_.notify_one();
+        }
+
+        bool pop(Job& job) {
+            std::unique_lock lock(mutex_);
+            not_empty_.wait(lock, [&] { return !jobs_.empty() || closed_; });
+            if (jobs_.empty()) {
+                return false;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            not_full_.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard lock(mutex_);
+            closed_ = true;
+            not_empty_.notify_all();
+        }
+
+    private:
+        std::size_t capacity_;
+        std::deque<Job> jobs_;
+        bool closed_ = false;
+        std::mutex mutex_;
+        std::condition_variable not_full_, not_empty_;
+    };
+
+}
+
+namespace mcts {
+
+    BatchStats analyze_sgf(std::istream& in, std::ostream& out, const BatchOptions& opts) {
+        JobQueue queue(opts.queue_capacity);
+        std::mutex out_mutex;
+
+        auto worker = [&](uint64_t seed) {
+            MCTS engine(seed);
+            Job job{0, 0, go::Board(1, 0)};
+            std::ostringstream line;
+            while (queue.pop(job)) {
+                go::Move best = engine.search(job.pos, opts.iters);
+                int visits = 0, wins = 0;
+                for (const MoveStats& s : engine.root_stats()) {
+                    if (s.move.v == best.v) {
+                        visits = s.v;
+                        wins = s.w;
+                    }
+                }
+                line.str("");
+                line << job.game << '\t' << job.ply << '\t'
+                     << (job.pos.to_play() == go::Color::Black ? 'B' : 'W') << '\t'
+                     << job.pos.coord(best) << '\t'
+                     << (visits > 0 ? static_cast<double>(wins) / visits : 0.0) << '\t'
+                     << visits << '\n';
+                std::lock_guard lock(out_mutex);
+                out << line.str();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        int threads = std::max(opts.threads, 1);
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(worker, opts.seed + i);
+        }
+
+        BatchStats stats;
+        go::SgfReader reader(in);
+        int every = std::max(opts.every, 1);
+        while (auto game = reader.next()) {
+            if (game->size < 2 || game->size > go::Board::MaxSize) {
+                continue;
+            }
+            go::Board pos = go::start_position(*game);
+            for (int ply = 0; ply <= static_cast<int>(game->moves.size()); ply++) {
+                if (ply > opts.max_ply) {
+                    break;
+                }
+                // analyze the position as the record continues it: setup stones and
+                // moves in a row by one color leave the wrong side to play
+                if (ply < static_cast<int>(game->moves.size()) && pos.to_play() != game->moves[ply].color) {
+                    pos.move(go::Move::Pass());
+                }
+                if (ply >= opts.min_ply && (ply - opts.min_ply) % every == 0) {
+                    queue.push({stats.games, ply, pos});
+                    stats.positions++;
+                }
+                if (ply < static_cast<int>(game->moves.size()) && !go::play(pos, game->moves[ply])) {
+                    break;  // illegal or malformed record, keep what was replayed
+                }
+            }
+            stats.games++;
+        }
+
+        queue.close();
+        for (std::thread& t : workers) {
+            t.join();
+        }
+        return stats;
+    }
+
+}  // namespace mcts
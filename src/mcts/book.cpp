@@ -0,0 +1,193 @@
+#include "mcts/book.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+    constexpr char MAGIC[8] = {'G', 'O', 'B', 'O', 'O', 'K', '1', '\0'};
+    constexpr uint32_t VERSION = 1;
+
+    uint64_t book_key(uint64_t hash) {
+        return hash == 0 ? 1 : hash;  // 0 is reserved for empty slots
+    }
+
+}
+
+namespace mcts {
+
+    struct Book::Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_size;
+        uint64_t capacity;
+        uint64_t reserved[5];
+    };
+
+    Book::~Book() {
+        close();
+    }
+
+    bool Book::map_file(int fd, std::size_t size, bool writable) {
+        int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+        void* map = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        ::close(fd);  // the mapping keeps the file alive
+        if (map == MAP_FAILED) {
+            return false;
+        }
+        map_ = map;
+        map_size_ = size;
+        writable_ = writable;
+        const Header* header = static_cast<const Header*>(map_);
+        capacity_ = header->capacity;
+        entries_ = reinterpret_cast<Entry*>(static_cast<char*>(map_) + sizeof(Header));
+        return true;
+    }
+
+    bool Book::create(const std::string& path, std::size_t capacity) {
+        close();
+        std::size_t slots = 1;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        std::size_t size = sizeof(Header) + slots * sizeof(Entry);
+
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {  // zero-filled: all slots empty
+            ::close(fd);
+            return false;
+        }
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.entry_size = sizeof(Entry);
+        header.capacity = slots;
+        if (pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            ::close(fd);
+            return false;
+        }
+        return map_file(fd, size, true);
+    }
+
+    bool Book::open(const std::string& path, bool writable) {
+        close();
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        Header header{};
+        if (fstat(fd, &st) != 0
+            || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+            || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+            || header.version != VERSION
+            || header.entry_size != sizeof(Entry)
+            || header.capacity == 0
+            || (header.capacity & (header.capacity - 1)) != 0
+            || static_cast<std::size_t>(st.st_size) != sizeof(Header) + header.capacity * sizeof(Entry)) {
+            ::close(fd);
+            return false;
+        }
+        return map_file(fd, static_cast<std::size_t>(st.st_size), writable);
+    }
+
+    void Book::close() {
+        if (map_ != nullptr) {
+            munmap(map_, map_size_);
+        }
+        map_ = nullptr;
+        map_size_ = 0;
+        capacity_ = 0;
+        writable_ = false;
+        entries_ = nullptr;
+    }
+
+    Book::Entry* Book::find_slot(uint64_t key) const {  // linear probing
+        std::size_t mask = capacity_ - 1;
+        for (std::size_t i = 0, idx = key & mask; i < capacity_; i++, idx = (idx + 1) & mask) {
+            Entry& e = entries_[idx];
+            if (e.key == key || e.key == 0) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    const Book::Entry* Book::probe(uint64_t key) const {
+        if (!is_open()) {
+            return nullptr;
+        }
+        key = book_key(key);
+        const Entry* e = find_slot(key);
+        if (e == nullptr || e->key != key) {
+            return nullptr;
+        }
+        return e;
+    }
+
+    bool Book::store(uint64_t key, const std::vector<MoveStats>& stats) {
+        if (!is_open() || !writable_) {
+            return false;
+        }
+        key = book_key(key);
+        Entry* e = find_slot(key);
+        if (e == nullptr) {  // table is full
+            return false;
+        }
+
+        std::vector<BookMove> moves(e->moves.begin(), e->moves.begin() + (e->key == key ? e->count : 0));
+        for (const MoveStats& s : stats) {
+            if (s.move.is_pass() || s.v <= 0) {
+                continue;
+            }
+            auto it = std::find_if(moves.begin(), moves.end(), [&](const BookMove& m) {
+                return m.v == s.move.v;
+            });
+            if (it == moves.end()) {
+                moves.push_back({s.move.v, 0, 0});
+                it = moves.end() - 1;
+            }
+            it->visits += s.v;
+            it->wins += s.w;
+        }
+        std::stable_sort(moves.begin(), moves.end(), [](const BookMove& a, const BookMove& b) {
+            return a.visits > b.visits;
+        });
+        if (moves.size() > MaxMoves) {
+            moves.resize(MaxMoves);
+        }
+
+        e->count = static_cast<uint32_t>(moves.size());
+        std::copy(moves.begin(), moves.end(), e->moves.begin());
+        e->key = key;
+        return true;
+    }
+
+    bool Book::merge(const Book& other) {
+        std::vector<MoveStats> stats;
+        for (std::size_t i = 0; i < other.capacity_; i++) {
+            const Entry& e = other.entries_[i];
+            if (e.key == 0) {
+                continue;
+            }
+            stats.clear();
+            for (uint32_t j = 0; j < e.count; j++) {
+                const BookMove& m = e.moves[j];
+                stats.push_back({go::Move(m.v), static_cast<int>(m.visits), static_cast<int>(m.wins)});
+            }
+            if (!store(e.key, stats)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}  // namespace mcts
@@ -0,0 +1,176 @@
+#include "mcts/endgame.h"
+
+#include <bit>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+    constexpr int MAX_DEPTH = 64;  // deeper lines (long ko fights) give up on the position
+    constexpr uint64_t PASS_KEY = 0x5bd1e9955bd1e995ULL;
+
+}
+
+namespace mcts {
+
+    EndgameSolver::EndgameSolver(int max_nodes, std::size_t table_size)
+        : moves_(MAX_DEPTH + 1),
+          max_nodes_(max_nodes)
+    {
+        std::size_t slots = 1;
+        while (slots < table_size) {
+            slots <<= 1;
+        }
+        table_.resize(slots);
+        for (std::vector<go::Move>& buffer : moves_) {
+            buffer.reserve(go::Board::MaxSize * go::Board::MaxSize + 1);
+        }
+        path_.reserve(MAX_DEPTH + 1);
+    }
+
+    int EndgameSolver::count_relevant(go::Board& pos) {
+        int count = 0;
+        for (int side = 0; side < 2; side++) {  // the mover, then the opponent after a pass
+            gen_moves(pos, moves_[0]);
+            count = std::max(count, static_cast<int>(moves_[0].size()));
+            pos.move(go::Move::Pass());
+        }
+        pos.undo(2);
+        return count;
+    }
+
+    void EndgameSolver::gen_moves(go::Board& pos, std::vector<go::Move>& moves) {
+        pos.gen_legal_moves(moves, true);
+        std::erase_if(moves, [&](go::Move m) {
+            return pos.is_self_atari(m) && !pos.is_capture(m);
+        });
+    }
+
+    EndgameSolver::Entry& EndgameSolver::slot(uint64_t key) {
+        return table_[key & (table_.size() - 1)];
+    }
+
+    std::optional<double> EndgameSolver::solve(go::Board& pos, go::Move* best) {
+        komi_key_ = go::Mix64(std::bit_cast<uint64_t>(pos.komi()));
+        uint64_t key = pos.hash() ^ komi_key_;
+        Entry& e = slot(key);
+        if (e.key == key && e.bound == Bound::Unsolved) {  // failed before, don't pay for it again
+            return std::nullopt;
+        }
+
+        nodes_ = 0;
+        aborted_ = false;
+        path_.assign(1, pos.hash());
+        repeated_ = std::numeric_limits<int>::max();
+        const double inf = std::numeric_limits<double>::infinity();
+        go::Move m = go::Move::Pass();
+        double score = negamax(pos, -inf, inf, 0, 0, &m);
+        if (aborted_) {
+            Entry& s = slot(key);
+            s = {.key = key, .score = 0, .best = -1, .bound = Bound::Unsolved};
+            return std::nullopt;
+        }
+        if (best != nullptr) {
+            *best = m;
+        }
+        return score;
+    }
+
+    double EndgameSolver::negamax(go::Board& pos, double alpha, double beta, int passes, int depth, go::Move* best) {
+        if (passes == 2) {
+            return pos.evaluate(pos.to_play());
+        }
+        if (++nodes_ > max_nodes_ || depth >= MAX_DEPTH) {
+            aborted_ = true;
+            return 0;
+        }
+
+        uint64_t key = pos.hash() ^ komi_key_ ^ (passes ? PASS_KEY : 0);
+        int tt_move = -1;
+        {
+            const Entry& e = slot(key);
+            if (e.key == key && e.bound != Bound::Unsolved) {
+                tt_move = e.best;
+                if (best == nullptr) {  // the root always searches, to report a move
+                    if (e.bound == Bound::Exact) {
+                        return e.score;
+                    }
+                    if (e.bound == Bound::Lower) {
+                        alpha = std::max(alpha, e.score);
+                    } else {
+                        beta = std::min(beta, e.score);
+                    }
+                    if (alpha >= beta) {
+                        return e.score;
+                    }
+                }
+            }
+        }
+
+        std::vector<go::Move>& moves = moves_[depth];
+        gen_moves(pos, moves);
+        std::stable_partition(moves.begin(), moves.end(), [&](go::Move m) {  // captures first
+            return pos.is_capture(m);
+        });
+        moves.push_back(go::Move::Pass());
+        if (tt_move != -1) {  // try the previous best move first
+            auto it = std::find_if(moves.begin(), moves.end(), [&](go::Move m) {
+                return m.v == tt_move;
+            });
+            if (it != moves.end()) {
+                std::iter_swap(moves.begin(), it);
+            }
+        }
+
+        double alpha0 = alpha;
+        int outer_repeated = repeated_;
+        repeated_ = std::numeric_limits<int>::max();
+        double best_score = -std::numeric_limits<double>::infinity();
+        go::Move best_move = go::Move::Pass();
+        for (std::size_t i = 0; i < moves.size(); i++) {
+            go::Move m = moves[i];
+            if (!pos.move(m)) {
+                continue;
+            }
+            auto repeat = m.is_pass() ? path_.end() : std::find(path_.begin(), path_.end(), pos.hash());
+            if (repeat != path_.end()) {
+                pos.undo();  // repeats a position of this line, would only go around in circles
+                repeated_ = std::min(repeated_, static_cast<int>(repeat - path_.begin()));
+                continue;
+            }
+            path_.push_back(pos.hash());
+            double score = -negamax(pos, -beta, -alpha, m.is_pass() ? passes + 1 : 0, depth + 1, nullptr);
+            path_.pop_back();
+            pos.undo();
+            if (aborted_) {
+                return 0;
+            }
+            if (score > best_score) {
+                best_score = score;
+                best_move = m;
+            }
+            alpha = std::max(alpha, score);
+            if (alpha >= beta) {
+                break;
+            }
+        }
+
+        if (best != nullptr) {
+            *best = best_move;
+        }
+        bool line_only = repeated_ < depth;  // path_[depth] is this position
+        repeated_ = std::min(repeated_, outer_repeated);
+        if (line_only) {
+            return best_score;
+        }
+        Entry& e = slot(key);
+        e = {
+            .key = key,
+            .score = best_score,
+            .best = best_move.v,
+            .bound = best_score <= alpha0 ? Bound::Upper : (best_score >= beta ? Bound::Lower : Bound::Exact)
+        };
+        return best_score;
+    }
+
+}  // namespace mcts
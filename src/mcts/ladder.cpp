@@ -0,0 +1,237 @@
+#include "mcts/ladder.h"
+
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+    constexpr int MAX_POINTS = (go::Board::MaxSize + 2) * (go::Board::MaxSize + 2);
+    // Plies of reading, two per defender move. A ladder running corner to corner
+    // takes about 2 * MaxSize defender moves; longer readings count as escaped.
+    constexpr int MAX_DEPTH = 4 * go::Board::MaxSize;
+
+}
+
+namespace mcts {
+
+    LadderReader::LadderReader()
+        : cache_(MAX_POINTS),
+          mark_(MAX_POINTS, 0),
+          xs_(MAX_POINTS, 0),
+          ys_(MAX_POINTS, 0)
+    {
+        stack_.reserve(MAX_POINTS);
+        adjacent_.reserve(MAX_POINTS);
+        escapes_.reserve(MAX_POINTS);
+    }
+
+    void LadderReader::cover(int v) {
+        int x = xs_[v];
+        int y = ys_[v];
+        x0_ = std::min(x0_, x);
+        y0_ = std::min(y0_, y);
+        x1_ = std::max(x1_, x);
+        y1_ = std::max(y1_, y);
+    }
+
+    int LadderReader::scan(const go::Board& pos, int v, int limit, int* libs, bool collect_adjacent) {
+        // everything looked at is added to the region, the result depends on nothing else
+        if (mark_id_ > std::numeric_limits<int>::max() - 2) {
+            std::fill(mark_.begin(), mark_.end(), 0);
+            mark_id_ = 0;
+        }
+        int count = 0;
+        int lib_mark = ++mark_id_;
+        int stone_mark = ++mark_id_;
+        if (collect_adjacent) {
+            adjacent_.clear();
+        }
+        stack_.clear();
+        stack_.push_back(v);
+        mark_[v] = stone_mark;
+        go::Point color = pos.at(v);
+        cover(v);
+        while (!stack_.empty()) {
+            int cur = stack_.back();
+            stack_.pop_back();
+            for (int neigh : pos.neigh4(cur)) {
+                go::Point p = pos.at(neigh);
+                if (p == go::Point::Wall || mark_[neigh] == lib_mark || mark_[neigh] == stone_mark) {
+                    continue;
+                }
+                cover(neigh);
+                if (p == go::Point::Empty) {
+                    mark_[neigh] = lib_mark;
+                    if (libs != nullptr && count < limit) {
+                        libs[count] = neigh;
+                    }
+                    if (++count >= limit && !collect_adjacent) {
+                        return count;
+                    }
+                } else if (p == color) {
+                    mark_[neigh] = stone_mark;
+                    stack_.push_back(neigh);
+                } else if (collect_adjacent) {
+                    mark_[neigh] = lib_mark;
+                    adjacent_.push_back(neigh);
+                }
+            }
+        }
+        return std::min(count, limit);
+    }
+
+    void LadderReader::cover_move(const go::Board& pos, int v, int covered_mark) {
+        // What Board::move does at v only depends on its neighbours and on whether
+        // the groups around it have a liberty other than v, which two are enough to show.
+        // Stones marked with covered_mark belong to a group that was fully scanned.
+        cover(v);
+        for (int neigh : pos.neigh4(v)) {
+            go::Point p = pos.at(neigh);
+            if (mark_[neigh] == covered_mark) {
+                continue;
+            }
+            if (p == go::Point::Black || p == go::Point::White) {
+                scan(pos, neigh, 2, nullptr);
+            } else if (p == go::Point::Empty) {
+                cover(neigh);
+            }
+        }
+    }
+
+    uint64_t LadderReader::region_hash(const go::Board& pos, int x0, int y0, int x1, int y1) const {
+        uint64_t h = 0;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                go::Point p = pos.at(x, y);
+                if (p != go::Point::Empty) {
+                    h ^= go::ZobristKey(pos.point(x, y), p);
+                }
+            }
+        }
+        int ko = pos.ko_age() == pos.ply_count() ? pos.ko_point() : -1;
+        if (ko != -1) {
+            int x = xs_[ko];
+            int y = ys_[ko];
+            if (x >= x0 && x <= x1 && y >= y0 && y <= y1) {
+                h ^= go::ZobristKey(ko, go::Point::Empty);
+            }
+        }
+        return h;
+    }
+
+    bool LadderReader::defend(go::Board& pos, int v, int depth) {  // owner to move
+        std::array<int, 2> libs;
+        int count = scan(pos, v, 2, libs.data(), true);
+        if (count != 1) {
+            return count == 0;
+        }
+        int group_mark = mark_id_;
+        int lib = libs[0];
+        int empty = 0;
+        for (int neigh : pos.neigh4(lib)) {
+            cover(neigh);
+            empty += pos.at(neigh) == go::Point::Empty;
+        }
+        if (empty >= 3) {  // extending gains three liberties whatever else happens
+            return false;
+        }
+
+        // escapes: capture an adjacent attacker group in atari, or extend. The
+        // captures are collected first, on top of the frames of outer readings,
+        // as the extension reading reuses adjacent_.
+        std::size_t base = escapes_.size();
+        int scanned = mark_id_;
+        for (int stone : adjacent_) {
+            if (mark_[stone] > scanned) {  // part of a group already looked at
+                continue;
+            }
+            std::array<int, 2> caps;
+            if (scan(pos, stone, 2, caps.data()) == 1 && caps[0] != lib
+                && std::find(escapes_.begin() + base, escapes_.end(), caps[0]) == escapes_.end()) {
+                escapes_.push_back(caps[0]);
+            }
+        }
+
+        bool captured = try_escape(pos, v, lib, group_mark, depth);
+        for (std::size_t i = base; captured && i < escapes_.size(); i++) {
+            captured = try_escape(pos, v, escapes_[i], group_mark, depth);
+        }
+        escapes_.resize(base);
+        return captured;
+    }
+
+    bool LadderReader::try_escape(go::Board& pos, int v, int m, int group_mark, int depth) {
+        cover_move(pos, m, group_mark);
+        if (!pos.move(go::Move(m))) {
+            return true;
+        }
+        std::array<int, 3> libs;
+        int count = scan(pos, v, 3, libs.data());
+        bool captured;
+        if (count >= 3 || depth >= MAX_DEPTH) {
+            captured = false;
+        } else if (count == 1) {
+            captured = true;
+        } else {
+            captured = attack(pos, v, libs[0], libs[1], mark_id_, depth + 1);  // the scan saw the whole group
+        }
+        pos.undo();
+        return captured;
+    }
+
+    bool LadderReader::attack(go::Board& pos, int v, int lib1, int lib2, int group_mark, int depth) {  // attacker to move
+        for (int lib : {lib1, lib2}) {
+            cover_move(pos, lib, group_mark);
+            if (!pos.move(go::Move(lib))) {
+                continue;
+            }
+            bool captured = defend(pos, v, depth + 1);
+            pos.undo();
+            if (captured) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool LadderReader::is_captured(go::Board& pos, int v) {
+        go::Point p = pos.at(v);
+        if (p != go::Point::Black && p != go::Point::White) {
+            return false;
+        }
+        if (stride_ != pos.size() + 2) {
+            stride_ = pos.size() + 2;
+            for (int i = 0; i < stride_ * stride_; i++) {
+                xs_[i] = static_cast<int8_t>(i % stride_ - 1);
+                ys_[i] = static_cast<int8_t>(i / stride_ - 1);
+            }
+        }
+
+        Entry& e = cache_[v];
+        if (e.size == pos.size() && e.to_play == pos.to_play()
+            && e.hash == region_hash(pos, e.x0, e.y0, e.x1, e.y1)) {
+            return e.captured;
+        }
+
+        x0_ = y0_ = pos.size();
+        x1_ = y1_ = -1;
+        bool captured;
+        if (go::Matches(p, pos.to_play())) {
+            captured = defend(pos, v, 0);
+        } else {
+            std::array<int, 3> libs;
+            int count = scan(pos, v, 3, libs.data());
+            captured = count == 1 || (count == 2 && attack(pos, v, libs[0], libs[1], mark_id_, 0));
+        }
+
+        e = {
+            .hash = region_hash(pos, x0_, y0_, x1_, y1_),
+            .size = pos.size(),
+            .to_play = pos.to_play(),
+            .x0 = x0_, .y0 = y0_, .x1 = x1_, .y1 = y1_,
+            .captured = captured
+        };
+        return captured;
+    }
+
+}  // namespace mcts
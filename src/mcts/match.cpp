@@ -0,0 +1,356 @@
+#include "mcts/match.h"
+
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+
+namespace {
+
+    std::string lower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return s;
+    }
+
+    // Reads a vertex as Board::coord writes it, "pass" included.
+    std::optional<go::Move> parse_move(const go::Board& pos, const std::string& text) {
+        std::string s = lower(text);
+        if (s == "pass") {
+            return go::Move::Pass();
+        }
+        if (s.size() < 2 || s[0] < 'a' || s[0] > 'z' || s[0] == 'i') {
+            return std::nullopt;
+        }
+        int x = s[0] - 'a' - (s[0] > 'i' ? 1 : 0);
+        int y = 0;
+        for (std::size_t i = 1; i < s.size(); i++) {
+            if (!std::isdigit(static_cast<unsigned char>(s[i])) || y > pos.size()) {
+                return std::nullopt;
+            }
+            y = 10 * y + (s[i] - '0');
+        }
+        y -= 1;
+        if (x >= pos.size() || y < 0 || y >= pos.size()) {
+            return std::nullopt;
+        }
+        return go::Move(pos.point(x, y));
+    }
+
+    std::optional<go::Color> parse_color(const std::string& text) {
+        std::string s = lower(text);
+        if (s == "b" || s == "black") {
+            return go::Color::Black;
+        }
+        if (s == "w" || s == "white") {
+            return go::Color::White;
+        }
+        return std::nullopt;
+    }
+
+    char color_letter(go::Color c) {
+        return c == go::Color::Black ? 'b' : 'w';
+    }
+
+    bool send_all(int fd, const std::string& text) {
+        std::size_t sent = 0;
+        while (sent < text.size()) {
+            ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                return false;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+}
+
+namespace mcts {
+
+    std::optional<go::Move> MCTSPlayer::genmove(const go::Board& pos, std::chrono::milliseconds time) {
+        return engine_.search(pos, std::numeric_limits<int>::max(), std::chrono::steady_clock::now() + time);
+    }
+
+    GtpPlayer::~GtpPlayer() {
+        stop();
+    }
+
+    bool GtpPlayer::start(const std::string& command) {
+        stop();
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            return false;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            dup2(fds[1], STDIN_FILENO);
+            dup2(fds[1], STDOUT_FILENO);
+            ::close(fds[0]);
+            ::close(fds[1]);
+            execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        ::close(fds[1]);
+        pid_ = pid;
+        socket_ = fds[0];
+        from_engine_ = fdopen(socket_, "r");
+        if (from_engine_ == nullptr) {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    void GtpPlayer::stop() {
+        if (pid_ < 0) {
+            return;
+        }
+        if (socket_ >= 0) {
+            send_all(socket_, "quit\n");
+            if (from_engine_ != nullptr) {
+                std::fclose(from_engine_);  // closes socket_ as well
+                from_engine_ = nullptr;
+            } else {
+                ::close(socket_);
+            }
+            socket_ = -1;
+        }
+        waitpid(pid_, nullptr, 0);
+        pid_ = -1;
+    }
+
+    std::optional<std::string> GtpPlayer::send(const std::string& command) {
+        if (from_engine_ == nullptr || !send_all(socket_, command + "\n")) {
+            return std::nullopt;
+        }
+
+        // the response is its first line, then lines up to an empty one
+        std::string response;
+        bool first = true;
+        char* line = nullptr;
+        std::size_t capacity = 0;
+        ssize_t length;
+        while ((length = getline(&line, &capacity, from_engine_)) >= 0) {
+            std::string s(line, static_cast<std::size_t>(length));
+            while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) {
+                s.pop_back();
+            }
+            if (first) {
+                if (s.empty()) {
+                    continue;
+                }
+                response = s;
+                first = false;
+            } else if (s.empty()) {
+                break;
+            }
+        }
+        std::free(line);
+
+        if (first || response[0] != '=') {
+            return std::nullopt;
+        }
+        std::size_t start = response.find_first_not_of(' ', 1);
+        return start == std::string::npos ? std::string() : response.substr(start);
+    }
+
+    void GtpPlayer::new_game(int size, double komi) {
+        std::ostringstream komi_text;
+        komi_text << komi;
+        send("boardsize " + std::to_string(size));
+        send("komi " + komi_text.str());
+        send("clear_board");
+    }
+
+    void GtpPlayer::play(const go::Board& pos, go::Move m) {
+        send(std::string("play ") + color_letter(pos.to_play()) + " " + pos.coord(m));
+    }
+
+    std::optional<go::Move> GtpPlayer::genmove(const go::Board& pos, std::chrono::milliseconds time) {
+        std::ostringstream seconds;
+        seconds << time.count() / 1000.0;
+        send("time_settings 0 " + seconds.str() + " 1");  // byo-yomi of one move per period
+        std::optional<std::string> reply = send(std::string("genmove ") + color_letter(pos.to_play()));
+        if (!reply) {
+            return std::nullopt;
+        }
+        return parse_move(pos, *reply);  // "resign" does not parse
+    }
+
+    MatchStats play_match(Player& first, Player& second, std::ostream& log, const MatchOptions& opts) {
+        MatchStats stats;
+        int max_moves = opts.max_moves > 0 ? opts.max_moves : 3 * opts.size * opts.size;
+        for (int game = 0; game < opts.games; game++) {
+            bool first_black = game % 2 == 0;
+            Player& black = first_black ? first : second;
+            Player& white = first_black ? second : first;
+            black.new_game(opts.size, opts.komi);
+            white.new_game(opts.size, opts.komi);
+
+            go::Board pos(opts.size, opts.komi);
+            int passes = 0, moves = 0;
+            std::optional<go::Color> loser;
+            while (passes < 2 && moves < max_moves) {
+                bool black_to_play = pos.to_play() == go::Color::Black;
+                Player& mover = black_to_play ? black : white;
+                Player& other = black_to_play ? white : black;
+                std::optional<go::Move> m = mover.genmove(pos, opts.move_time);
+                if (!m || !pos.is_legal(*m)) {
+                    loser = pos.to_play();
+                    break;
+                }
+                other.play(pos, *m);
+                pos.move(*m);
+                passes = m->is_pass() ? passes + 1 : 0;
+                moves++;
+            }
+
+            double score = pos.evaluate(go::Color::Black);
+            go::Color winner = loser ? go::Opp(*loser) : (score > 0 ? go::Color::Black : go::Color::White);
+            bool first_won = (winner == go::Color::Black) == first_black;
+            stats.games++;
+            (first_won ? stats.first_wins : stats.second_wins)++;
+
+            log << game << '\t' << (first_black ? "first" : "second") << '\t'
+                << (first_won ? "first" : "second") << '\t';
+            if (loser) {
+                log << "resign";
+            } else {
+                log << score;
+            }
+            log << '\t' << moves << '\n';
+        }
+        return stats;
+    }
+
+    void serve_gtp(std::istream& in, std::ostream& out, MCTS& engine) {
+        static const char* const commands[] = {
+            "protocol_version", "name", "version", "known_command", "list_commands", "quit",
+            "boardsize", "clear_board", "komi", "play", "genmove", "time_settings"
+        };
+
+        int size = 19;
+        double komi = 7.5;
+        go::Board pos(size, komi);
+        std::chrono::milliseconds move_time{1000};
+
+        std::string line;
+        while (std::getline(in, line)) {
+            line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+            std::size_t hash = line.find('#');
+            if (hash != std::string::npos) {
+                line.erase(hash);
+            }
+            std::istringstream args(line);
+            std::string id, command;
+            if (!(args >> command)) {
+                continue;
+            }
+            if (std::all_of(command.begin(), command.end(), [](unsigned char c) { return std::isdigit(c); })) {
+                id = command;
+                if (!(args >> command)) {
+                    continue;
+                }
+            }
+
+            bool ok = true;
+            std::string response;
+            if (command == "protocol_version") {
+                response = "2";
+            } else if (command == "name") {
+                response = "go-engine";
+            } else if (command == "version") {
+                response = "";
+            } else if (command == "known_command") {
+                std::string name;
+                args >> name;
+                response = std::find_if(std::begin(commands), std::end(commands), [&](const char* c) {
+                    return name == c;
+                }) != std::end(commands) ? "true" : "false";
+            } else if (command == "list_commands") {
+                for (const char* c : commands) {
+                    response += response.empty() ? c : std::string("\n") + c;
+                }
+            } else if (command == "boardsize") {
+                int n = 0;
+                if (args >> n && n >= 2 && n <= go::Board::MaxSize) {
+                    size = n;
+                    pos = go::Board(size, komi);
+                } else {
+                    ok = false;
+                    response = "unacceptable size";
+                }
+            } else if (command == "clear_board") {
+                pos = go::Board(size, komi);
+            } else if (command == "komi") {
+                double k;
+                if (args >> k) {
+                    komi = k;
+                    if (pos.ply_count() == 0) {  // the board takes komi at construction
+                        pos = go::Board(size, komi);
+                    }
+                } else {
+                    ok = false;
+                    response = "syntax error";
+                }
+            } else if (command == "play") {
+                std::string c, v;
+                args >> c >> v;
+                std::optional<go::Color> color = parse_color(c);
+                std::optional<go::Move> m = parse_move(pos, v);
+                if (!color || !m) {
+                    ok = false;
+                    response = "syntax error";
+                } else if (!pos.play_as(*color, *m)) {
+                    ok = false;
+                    response = "illegal move";
+                }
+            } else if (command == "genmove") {
+                std::string c;
+                args >> c;
+                std::optional<go::Color> color = parse_color(c);
+                if (!color) {
+                    ok = false;
+                    response = "syntax error";
+                } else {
+                    if (pos.to_play() != *color) {
+                        pos.move(go::Move::Pass());
+                    }
+                    go::Move m = engine.search(pos, std::numeric_limits<int>::max(),
+                                               std::chrono::steady_clock::now() + move_time);
+                    pos.move(m);
+                    response = pos.coord(m);
+                }
+            } else if (command == "time_settings") {
+                double main_time = 0, byo_yomi = 0;
+                int stones = 0;
+                args >> main_time >> byo_yomi >> stones;
+                if (byo_yomi > 0 && stones > 0) {  // only the per move time of byo-yomi is used
+                    move_time = std::chrono::milliseconds(static_cast<long>(1000 * byo_yomi / stones));
+                }
+            } else if (command == "quit") {
+                out << "=" << id << "\n\n" << std::flush;
+                return;
+            } else {
+                ok = false;
+                response = "unknown command";
+            }
+
+            out << (ok ? '=' : '?') << id << (response.empty() ? "" : " ") << response << "\n\n" << std::flush;
+        }
+    }
+
+}  // namespace mcts
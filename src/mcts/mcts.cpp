@@ -1,27 +1,90 @@
 #include "mcts/mcts.h"
 
 #include <cmath>
+#include <utility>
+#include <optional>
+#include <algorithm>
 
 #include "mcts/playout.h"
 
 namespace mcts {
 
     go::Move MCTS::search(go::Board pos, int iters) {
+        return search(std::move(pos), iters, std::chrono::steady_clock::time_point::max());
+    }
+
+    go::Move MCTS::search(go::Board pos, int iters, std::chrono::steady_clock::time_point deadline) {
+        uint32_t id = started_.fetch_add(1, std::memory_order_relaxed) + 1;
         nodes_.clear();
         nodes_.emplace_back(go::Move::Pass(), -1);
         int root_ply_count = pos.ply_count();
 
+        if (seed_from_book(pos)) {
+            iters = 0;
+        }
+        std::optional<go::Move> solved;
+        if (iters > 0) {
+            go::Move m;
+            if (std::optional<double> score = solve_endgame(pos, &m)) {
+                // report the solved move in root_stats and analysis, as a child
+                // of its own if expand leaves it out: a pass, a capture inside an
+                // eye, or a move pruned by symmetry
+                expand(0, pos);
+                auto it = std::find_if(nodes_[0].children.begin(), nodes_[0].children.end(), [&](int child_id) {
+                    return nodes_[child_id].move.v == m.v;
+                });
+                int child_id = it != nodes_[0].children.end() ? *it : static_cast<int>(nodes_.size());
+                if (it == nodes_[0].children.end()) {
+                    nodes_.push_back(Node{.move = m, .parent = 0, .children = {}, .just_played = pos.to_play()});
+                    nodes_[0].children.push_back(child_id);
+                }
+                Node& child = nodes_[child_id];
+                child.v = 1;
+                child.w = *score > 0;
+                child.solved = true;
+                child.score = -*score;
+                nodes_[0].v = 1;
+                solved = m;
+                iters = 0;
+            }
+        }
+
         std::vector<go::Point> amaf_map;
+        const int CLOCK_INTERVAL = 64;  // iterations between clock reads
+        auto next_analysis = std::chrono::steady_clock::now() + analysis_interval_;
         for (int it = 0; it < iters; it++) {
-            amaf_map.assign((pos.size() + 1) * (pos.size() + 1), go::Point::Empty);
+            if (stopped_.load(std::memory_order_relaxed) == id) {
+                break;
+            }
+            if (it % CLOCK_INTERVAL == 0 && it > 0) {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    break;
+                }
+                if (analysis_ && now >= next_analysis) {
+                    analysis_(analysis(analysis_moves_));
+                    next_analysis = now + analysis_interval_;
+                }
+            }
+            if (periodic_ && periodic_interval_ > 0 && it > 0 && it % periodic_interval_ == 0) {
+                periodic_(*this);
+            }
+            amaf_map.assign((pos.size() + 2) * (pos.size() + 2), go::Point::Empty);
 
             int leaf = descend(pos, amaf_map);
+            if (nodes_[leaf].solved) {
+                backprop(leaf, nodes_[leaf].score, amaf_map);
+                pos.undo(pos.ply_count() - root_ply_count);
+                continue;
+            }
 
             if (nodes_[leaf].children.empty()) {
                 expand(leaf, pos);
-                int child = nodes_[leaf].children[0];
-                pos.move(nodes_[child].move);
-                leaf = child;
+                if (!nodes_[leaf].children.empty()) {  // otherwise no moves are left, score the leaf as is
+                    int child = nodes_[leaf].children[0];
+                    pos.move(nodes_[child].move);
+                    leaf = child;
+                }
             }
 
             double score = playout(pos, amaf_map);
@@ -29,6 +92,12 @@ namespace mcts {
             pos.undo(pos.ply_count() - root_ply_count);  // rollback
         }
 
+        if (analysis_) {
+            analysis_(analysis(analysis_moves_));
+        }
+        if (solved) {
+            return *solved;
+        }
         if (nodes_[0].children.empty()) {
             return go::Move::Pass();
         }
@@ -43,6 +112,139 @@ namespace mcts {
         return nodes_[best_child].move;
     }
 
+    std::vector<MoveStats> MCTS::root_stats() const {
+        std::vector<MoveStats> stats;
+        if (nodes_.empty()) {
+            return stats;
+        }
+        for (int child_id : nodes_[0].children) {
+            const Node& child = nodes_[child_id];
+            stats.push_back({child.move, child.v, child.w});
+        }
+        return stats;
+    }
+
+    Analysis MCTS::analysis(int top_moves) const {
+        const int MAX_PV = 16;
+        const int PV_MIN_VISITS = 2;  // a single visit is the expansion playout, not a choice
+        Analysis result;
+        if (nodes_.empty()) {
+            return result;
+        }
+        result.visits = nodes_[0].v;
+
+        auto most_visited = [&](const Node& node) {
+            int best = -1;
+            for (int child_id : node.children) {
+                if (nodes_[child_id].v >= PV_MIN_VISITS && (best == -1 || nodes_[child_id].v > nodes_[best].v)) {
+                    best = child_id;
+                }
+            }
+            return best;
+        };
+
+        std::vector<int> order;
+        for (int child_id : nodes_[0].children) {
+            if (nodes_[child_id].v > 0) {
+                order.push_back(child_id);
+            }
+        }
+        int count = std::min(static_cast<int>(order.size()), std::max(top_moves, 0));
+        std::partial_sort(order.begin(), order.begin() + count, order.end(), [&](int a, int b) {
+            return nodes_[a].v > nodes_[b].v;
+        });
+
+        for (int i = 0; i < count; i++) {
+            const Node& child = nodes_[order[i]];
+            MoveAnalysis move{
+                .move = child.move,
+                .visits = child.v,
+                .winrate = static_cast<double>(child.w) / child.v,
+                .pv = {}
+            };
+            for (int id = order[i]; id != -1 && static_cast<int>(move.pv.size()) < MAX_PV; id = most_visited(nodes_[id])) {
+                move.pv.push_back(nodes_[id].move);
+            }
+            result.moves.push_back(std::move(move));
+        }
+        return result;
+    }
+
+    void MCTS::add_root_priors(const std::vector<MoveStats>& stats) {
+        if (!nodes_.empty()) {
+            add_priors(0, stats, std::numeric_limits<int>::max());
+        }
+    }
+
+    bool MCTS::seed_from_book(go::Board& pos) {
+        if (book_ == nullptr) {
+            return false;
+        }
+        const Book::Entry* entry = book_->probe(pos.hash());
+        if (entry == nullptr || entry->count == 0) {
+            return false;
+        }
+
+        std::vector<MoveStats> stats;
+        for (uint32_t i = 0; i < entry->count; i++) {
+            const Book::BookMove& m = entry->moves[i];
+            stats.push_back({go::Move(m.v), static_cast<int>(m.visits), static_cast<int>(m.wins)});
+        }
+        expand(0, pos);
+
+        const int BOOK_MOVE_VISITS = 5000;
+        int second = stats.size() > 1 ? stats[1].v : 0;
+        if (stats[0].v >= BOOK_MOVE_VISITS && stats[0].v >= 2 * second) {  // trusted: play without searching
+            bool found = false;
+            for (int child_id : nodes_[0].children) {
+                Node& child = nodes_[child_id];
+                for (const MoveStats& s : stats) {
+                    if (s.move.v == child.move.v) {
+                        child.v = s.v;
+                        child.w = s.w;
+                        found |= s.move.v == stats[0].move.v;
+                    }
+                }
+            }
+            if (found) {
+                return true;
+            }
+            for (int child_id : nodes_[0].children) {
+                nodes_[child_id].v = nodes_[child_id].w = 0;
+            }
+        }
+
+        const int BOOK_PRIOR_VISITS = 200;
+        add_priors(0, stats, BOOK_PRIOR_VISITS);
+        return false;
+    }
+
+    std::optional<double> MCTS::solve_endgame(go::Board& pos, go::Move* best) {
+        if (endgame_points_ <= 0 || endgame_.count_relevant(pos) > endgame_points_) {
+            return std::nullopt;
+        }
+        return endgame_.solve(pos, best);
+    }
+
+    void MCTS::add_priors(int node_id, const std::vector<MoveStats>& stats, int max_prior) {
+        int max_v = 0;
+        for (const MoveStats& s : stats) {
+            max_v = std::max(max_v, s.v);
+        }
+        if (max_v == 0) {
+            return;
+        }
+        double scale = std::min(1.0, static_cast<double>(max_prior) / max_v);  // keep room for the search itself
+        for (int child_id : nodes_[node_id].children) {
+            Node& child = nodes_[child_id];
+            for (const MoveStats& s : stats) {
+                if (s.move.v == child.move.v) {
+                    child.pv += static_cast<int>(s.v * scale);
+                    child.pw += static_cast<int>(s.w * scale);
+                }
+            }
+        }
+    }
 
     int MCTS::select_child(int parent_id) {
         const Node& parent = nodes_[parent_id];
@@ -83,20 +285,67 @@ namespace mcts {
             return;
         }
         std::vector<go::Move> moves;
-        pos.gen_pseudo_legal_moves(moves);
+        pos.gen_legal_moves(moves);
+        int symmetries = pos.symmetries();  // keep one move per class of equivalent moves
         for (go::Move m : moves) {
+            if (symmetries != 1 && !pos.is_canonical(m.v, symmetries)) {
+                continue;
+            }
             Node child{
                 .move = m,
                 .parent = node_id,
                 .just_played = pos.to_play()
             };
+            add_tactical_prior(child, pos);
             nodes_.push_back(child);
             int child_id = static_cast<int>(nodes_.size()) - 1;
             nodes_[node_id].children.push_back(child_id);
         }
     }
 
+    void MCTS::add_tactical_prior(Node& child, go::Board& pos) {
+        const int PRIOR_LADDER = 10;
+        go::Move m = child.move;
+        std::array<int, 3> libs;
+        std::array<int, 4> done;  // groups already counted, by color and liberties as in the playouts
+        int n_done = 0;
+        for (int neigh : pos.neigh4(m.v)) {
+            go::Point p = pos.at(neigh);
+            if (p == go::Point::Empty || p == go::Point::Wall) {
+                continue;
+            }
+            int count = pos.liberties(neigh, libs);
+            if (count > 2) {
+                continue;
+            }
+            int other = count == 2 ? libs[0] + libs[1] - m.v : 0;  // one liberty is m itself
+            int key = other * 4 + static_cast<int>(p);
+            if (std::find(done.begin(), done.begin() + n_done, key) != done.begin() + n_done) {
+                continue;
+            }
+            done[n_done++] = key;
+            bool own = go::Matches(p, pos.to_play());
+            if (count == 1) {
+                if (!own || !ladders_.is_captured(pos, neigh)) {  // capture, or an escape that works
+                    child.pv += PRIOR_LADDER;
+                    child.pw += PRIOR_LADDER;
+                } else {  // running out of a working ladder
+                    child.pv += PRIOR_LADDER;
+                }
+            } else if (count == 2 && !own && pos.move(m)) {
+                if (ladders_.is_captured(pos, neigh)) {  // atari that starts a working ladder
+                    child.pv += PRIOR_LADDER;
+                    child.pw += PRIOR_LADDER;
+                }
+                pos.undo();
+            }
+        }
+    }
+
     int MCTS::descend(go::Board& pos, std::vector<go::Point>& amaf_map) {
+        // Solving is tried once per node after a few visits: a fresh leaf
+        // is usually too large to solve, and a failed try costs many playouts.
+        const int ENDGAME_VISITS = 16;
         int cur_id = 0;
         while (!nodes_[cur_id].children.empty()) {
             int child_id = select_child(cur_id);
@@ -108,6 +357,15 @@ namespace mcts {
             }
 
             cur_id = child_id;
+            if (!child.solved && child.v == ENDGAME_VISITS) {
+                if (std::optional<double> score = solve_endgame(pos)) {
+                    child.solved = true;
+                    child.score = *score;
+                }
+            }
+            if (child.solved) {
+                break;
+            }
         }
         return cur_id;
     }
@@ -118,7 +376,7 @@ namespace mcts {
         go::Color perspective = pos.to_play();
 
         while (passes < 2 && moves++ < max_moves) {
-            go::Move m = play_heuristic_move(pos, rng_);
+            go::Move m = play_heuristic_move(pos, rng_, ladders_);
             if (m.is_pass()) {
                 passes++;
             } else {
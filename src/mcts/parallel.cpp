@@ -0,0 +1,180 @@
+#include "mcts/parallel.h"
+
+#include <new>
+#include <atomic>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "mcts/mcts.h"
+
+namespace {
+
+    constexpr int MAX_POINTS = (go::Board::MaxSize + 2) * (go::Board::MaxSize + 2);
+    constexpr int READ_RETRIES = 64;  // then the previous copy of the slot is used
+
+    // Root statistics of one worker, indexed by point. The sequence counter is
+    // odd while the owner writes.
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq{0};
+        std::atomic<int32_t> visits[MAX_POINTS] = {};
+        std::atomic<int32_t> wins[MAX_POINTS] = {};
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,
+                  "slots are shared between processes");
+
+    int index(go::Move m) {  // point 0 is a corner of the wall, free for the pass
+        return m.is_pass() ? 0 : m.v;
+    }
+
+    void publish(Slot& slot, const std::vector<mcts::MoveStats>& stats) {
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (const mcts::MoveStats& s : stats) {
+            slot.visits[index(s.move)].store(s.v, std::memory_order_relaxed);
+            slot.wins[index(s.move)].store(s.w, std::memory_order_relaxed);
+        }
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Fills v and w of stats for their moves, false if the owner kept writing.
+    bool read(const Slot& slot, std::vector<mcts::MoveStats>& stats) {
+        for (int attempt = 0; attempt < READ_RETRIES; attempt++) {
+            uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            for (mcts::MoveStats& s : stats) {
+                s.v = slot.visits[index(s.move)].load(std::memory_order_relaxed);
+                s.w = slot.wins[index(s.move)].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == seq) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    go::Move run_worker(mcts::MCTS& engine, const go::Board& root, const mcts::RootParallelOptions& opts,
+                    Slot* slots, int workers, int id) {
+        std::vector<std::vector<mcts::MoveStats>> seen(workers);  // last consistent copy of each slot
+        std::vector<mcts::MoveStats> injected, delta;
+        engine.set_periodic([&](mcts::MCTS& e) {
+            std::vector<mcts::MoveStats> own = e.root_stats();
+            publish(slots[id], own);
+            if (injected.empty()) {
+                injected = own;
+                for (mcts::MoveStats& s : injected) {
+                    s.v = s.w = 0;
+                }
+            }
+
+            delta = injected;
+            for (mcts::MoveStats& s : delta) {
+                s.v = s.w = 0;
+            }
+            for (int j = 0; j < workers; j++) {
+                if (j == id) {
+                    continue;
+                }
+                std::vector<mcts::MoveStats> copy = injected;
+                if (read(slots[j], copy)) {
+                    seen[j] = std::move(copy);
+                }
+                for (std::size_t i = 0; i < seen[j].size(); i++) {
+                    delta[i].v += seen[j][i].v;
+                    delta[i].w += seen[j][i].w;
+                }
+            }
+            for (std::size_t i = 0; i < delta.size(); i++) {  // counts only grow, add what is new
+                int v = delta[i].v, w = delta[i].w;
+                delta[i].v = std::max(v - injected[i].v, 0);
+                delta[i].w = std::max(w - injected[i].w, 0);
+                injected[i].v = std::max(v, injected[i].v);
+                injected[i].w = std::max(w, injected[i].w);
+            }
+            e.add_root_priors(delta);
+        }, opts.sync_interval);
+
+        go::Move best = engine.search(root, opts.iters);
+        publish(slots[id], engine.root_stats());
+        return best;
+    }
+
+}
+
+namespace mcts {
+
+    go::Move root_parallel_search(const go::Board& root, const RootParallelOptions& opts,
+                                  std::vector<MoveStats>* merged) {
+        int workers = std::max(opts.workers, 1);
+        std::size_t size = workers * sizeof(Slot);
+        void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) {
+            workers = 1;
+            map = nullptr;
+        }
+        Slot local;
+        Slot* slots = map != nullptr ? static_cast<Slot*>(map) : &local;
+        if (map != nullptr) {
+            for (int i = 0; i < workers; i++) {
+                new (&slots[i]) Slot();
+            }
+        }
+
+        std::vector<pid_t> children;
+        for (int i = 1; i < workers; i++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                MCTS engine(opts.seed + i);
+                engine.set_book(opts.book);
+                run_worker(engine, root, opts, slots, workers, i);
+                _exit(0);
+            }
+            if (pid > 0) {
+                children.push_back(pid);
+            }  // a worker that could not be forked leaves its slot empty
+        }
+
+        MCTS engine(opts.seed);  // this process is worker 0
+        engine.set_book(opts.book);
+        go::Move own_best = run_worker(engine, root, opts, slots, workers, 0);
+        for (pid_t pid : children) {
+            waitpid(pid, nullptr, 0);
+        }
+
+        std::vector<MoveStats> stats = engine.root_stats();
+        std::vector<MoveStats> copy = stats;
+        for (int j = 1; j < workers; j++) {
+            if (!read(slots[j], copy)) {  // a worker that died while writing
+                continue;
+            }
+            for (std::size_t i = 0; i < stats.size(); i++) {
+                stats[i].v += copy[i].v;
+                stats[i].w += copy[i].w;
+            }
+        }
+        if (map != nullptr) {
+            munmap(map, size);
+        }
+
+        go::Move best = own_best;  // kept when nothing was visited, e.g. a root decided by the book or the solver
+        int max_visits = 0;
+        for (const MoveStats& s : stats) {
+            if (s.v > max_visits) {
+                max_visits = s.v;
+                best = s.move;
+            }
+        }
+        if (merged != nullptr) {
+            *merged = std::move(stats);
+        }
+        return best;
+    }
+
+}  // namespace mcts
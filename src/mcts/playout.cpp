@@ -1,5 +1,6 @@
 #include "mcts/playout.h"
 
+#include <array>
 #include <random>
 #include <algorithm>
 
@@ -27,7 +28,31 @@ namespace mcts {
         }
     }
 
-    go::Move play_heuristic_move(go::Board& pos, RNG& rng) {
+    void gen_playout_moves_atari(go::Board& pos, std::vector<go::Move>& moves, LadderReader& ladders) {
+        moves.clear();
+        auto [neigh, n] = pos.last_moves_neigh();
+        std::array<int, 2> libs;
+        std::array<int, 18> done;  // (liberty, color) of the groups already handled
+        int n_done = 0;
+        for (int i = 0; i < n; i++) {
+            int v = neigh[i];
+            go::Point p = pos.at(v);
+            if (p == go::Point::Empty || p == go::Point::Wall || pos.liberties(v, libs) != 1) {
+                continue;
+            }
+            int key = libs[0] * 4 + static_cast<int>(p);
+            if (std::find(done.begin(), done.begin() + n_done, key) != done.begin() + n_done) {
+                continue;
+            }
+            done[n_done++] = key;
+            // capture a group in atari, or run out of one unless the ladder works
+            if (!go::Matches(p, pos.to_play()) || !ladders.is_captured(pos, v)) {
+                moves.push_back(go::Move(libs[0]));
+            }
+        }
+    }
+
+    go::Move play_heuristic_move(go::Board& pos, RNG& rng, LadderReader& ladders) {
         std::vector<go::Move> moves;
         std::uniform_real_distribution<double> dist(0.0, 1.0);
 
@@ -49,6 +74,13 @@ namespace mcts {
                 return m;
             }
         }
+        if (dist(rng) < 0.3) {
+            gen_playout_moves_atari(pos, moves, ladders);
+            m = random_move();
+            if (!m.is_pass()) {
+                return m;
+            }
+        }
         /*if (dist(rng) < 0.3) {
             gen_playout_moves_capture(pos, moves);
             m = random_move();
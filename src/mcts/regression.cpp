@@ -0,0 +1,219 @@
+#include "mcts/regression.h"
+
+#include <chrono>
+#include <utility>
+#include <algorithm>
+
+#include "go/sgf.h"
+#include "mcts/mcts.h"
+
+namespace mcts {
+
+    go::Board setup_position(const TestPosition& position) {
+        go::SgfGame game;
+        game.size = static_cast<int>(position.rows.size());
+        game.komi = position.komi;
+        for (int row = 0; row < game.size; row++) {
+            const std::string& line = position.rows[row];
+            for (int x = 0; x < std::min(game.size, static_cast<int>(line.size())); x++) {
+                int y = game.size - 1 - row;
+                if (line[x] == 'X') {
+                    game.setup.push_back({go::Color::Black, x, y});
+                } else if (line[x] == 'O') {
+                    game.setup.push_back({go::Color::White, x, y});
+                }
+            }
+        }
+        go::Board board = go::start_position(game);
+        if (board.to_play() != position.to_play) {
+            board.move(go::Move::Pass());
+        }
+        return board;
+    }
+
+    TestPosition transformed(const TestPosition& position, int sym) {
+        int n = static_cast<int>(position.rows.size());
+        auto apply = [&](int x, int y) {
+            if (sym & 1) {
+                x = n - 1 - x;
+            }
+            if (sym & 2) {
+                y = n - 1 - y;
+            }
+            if (sym & 4) {
+                std::swap(x, y);
+            }
+            return std::pair(x, y);
+        };
+
+        TestPosition result = position;
+        result.name += "/" + std::to_string(sym);
+        result.rows.assign(n, std::string(n, '.'));
+        result.answers.clear();
+        go::Board board(n, position.komi);
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                auto [tx, ty] = apply(x, y);
+                const std::string& line = position.rows[n - 1 - y];
+                result.rows[n - 1 - ty][tx] = x < static_cast<int>(line.size()) ? line[x] : '.';
+                std::string from = board.coord(go::Move(board.point(x, y)));
+                if (std::find(position.answers.begin(), position.answers.end(), from) != position.answers.end()) {
+                    result.answers.push_back(board.coord(go::Move(board.point(tx, ty))));
+                }
+            }
+        }
+        if (std::find(position.answers.begin(), position.answers.end(), "pass") != position.answers.end()) {
+            result.answers.push_back("pass");
+        }
+        return result;
+    }
+
+    const std::vector<TestPosition>& standard_suite() {
+        // The 9x9 problems sit in a corner cut off by white, with the rest of
+        // the board split so that the group's fate decides the game. Every move
+        // of the 5x5 endgames was solved with EndgameSolver and a large node
+        // budget, and only the answer wins; like the solver, this leaves out
+        // throw-ins. Moves are generated from A1 on, so every problem also
+        // appears mirrored and rotated, and versions whose answer is the first
+        // move generated are left out: one iteration already plays that move.
+        static const std::vector<TestPosition> problems = {
+            {
+                "straight-three-live", 6.5, go::Color::Black,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", ".....XO..",
+                 "XXXXXXO..", "OOOOOOO..", "XXXXO....", "...XO...."},
+                {"B1"}
+            },
+            {
+                "straight-three-kill", 6.5, go::Color::White,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", ".....XO..",
+                 "XXXXXXO..", "OOOOOOO..", "XXXXO....", "...XO...."},
+                {"B1"}
+            },
+            {
+                "pyramid-four-live", 4.5, go::Color::Black,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", "XXXXXXO..",
+                 "OOOOOOO..", "OXXXOO...", "XX.XXO...", "X...XO..."},
+                {"C1"}
+            },
+            {
+                "pyramid-four-kill", 4.5, go::Color::White,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", "XXXXXXO..",
+                 "OOOOOOO..", "OXXXOO...", "XX.XXO...", "X...XO..."},
+                {"C1"}
+            },
+            {
+                "rabbity-six-live", 4.5, go::Color::Black,
+                {".....XO..", ".....XO..", ".....XO..", "XXXXXXO..", "OOOOOOO..",
+                 "XXXXXXO..", "XX.XXXO..", "X...XXO..", "XX..XXO.."},
+                {"C2"}
+            },
+            {
+                "rabbity-six-kill", 4.5, go::Color::White,
+                {".....XO..", ".....XO..", ".....XO..", "XXXXXXO..", "OOOOOOO..",
+                 "XXXXXXO..", "XX.XXXO..", "X...XXO..", "XX..XXO.."},
+                {"C2"}
+            },
+            {
+                "bulky-five-kill", 6.5, go::Color::White,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", "XXXXXXO..",
+                 "OOOOOOO..", "XXXXOO...", "X..XXO...", "X...XO..."},
+                {"C1"}
+            },
+            {
+                "capture-for-second-eye", 6.5, go::Color::Black,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", "XXXXXXO..",
+                 "OOOOOOO..", "XXXXXO...", "X.XXXO...", "XXXO.O..."},
+                {"E1"}
+            },
+            {
+                "connect-and-kill", 6.5, go::Color::White,
+                {".....XO..", ".....XO..", ".....XO..", ".....XO..", "XXXXXXO..",
+                 "OOOOOOO..", "XXXXXO...", "X.XXXO...", "XXXO.O..."},
+                {"E1"}
+            },
+            {
+                "false-eye-defend", 2.5, go::Color::Black,
+                {"X.X.XXO..", "XXXXXXO..", ".X.X.XO..", "XXXXXXO..", "XXXXXXO..",
+                 "OOOOOOO..", "XXXXO....", "XXX.OO...", ".X.XXO..."},
+                {"D2"}
+            },
+            {
+                "false-eye-kill", 2.5, go::Color::White,
+                {"X.X.XXO..", "XXXXXXO..", ".X.X.XO..", "XXXXXXO..", "XXXXXXO..",
+                 "OOOOOOO..", "XXXXO....", "XXX.OO...", ".X.XXO..."},
+                {"D2"}
+            },
+            {
+                "endgame-5x5-a", 5.5, go::Color::Black,
+                {".XXO.", "X.X.O", "..X.O", ".XXOO", "XXOO."},
+                {"D4"}
+            },
+            {
+                "endgame-5x5-b", 1.5, go::Color::Black,
+                {"..XOX", "OOO..", "XXXOO", ".OXXX", "O...."},
+                {"D4"}
+            }
+        };
+        static const std::vector<TestPosition> suite = [] {
+            std::vector<TestPosition> result;
+            std::vector<go::Move> moves;
+            // as given, mirrored top to bottom, rotated by 180 and by 90 degrees
+            for (int sym : {0, 2, 3, 6}) {
+                for (const TestPosition& problem : problems) {
+                    TestPosition position = sym == 0 ? problem : transformed(problem, sym);
+                    go::Board pos = setup_position(position);
+                    pos.gen_legal_moves(moves);
+                    if (moves.empty() || std::find(position.answers.begin(), position.answers.end(),
+                                                   pos.coord(moves[0])) == position.answers.end()) {
+                        result.push_back(std::move(position));
+                    }
+                }
+            }
+            return result;
+        }();
+        return suite;
+    }
+
+    SuiteStats run_suite(const std::vector<TestPosition>& positions, std::ostream& out, const SuiteOptions& opts) {
+        SuiteStats stats;
+        for (const TestPosition& position : positions) {
+            go::Board pos = setup_position(position);
+            for (int s = 0; s < opts.seeds; s++) {
+                uint64_t seed = opts.seed + s;
+                int found_iters = 0;
+                double found_seconds = 0;
+                bool settled = false;
+                std::string move;
+                for (int iters = std::max(opts.min_iters, 1); iters <= opts.max_iters; iters *= 2) {
+                    MCTS engine(seed);
+                    auto start = std::chrono::steady_clock::now();
+                    move = pos.coord(engine.search(pos, iters));
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    bool correct = std::find(position.answers.begin(), position.answers.end(), move) != position.answers.end();
+                    if (!correct) {
+                        found_iters = 0;
+                    } else if (found_iters == 0) {
+                        found_iters = iters;
+                        found_seconds = seconds;
+                    } else {
+                        settled = true;
+                        break;
+                    }
+                }
+
+                stats.runs++;
+                if (settled) {
+                    stats.settled++;
+                    stats.iters += found_iters;
+                    stats.seconds += found_seconds;
+                }
+                out << position.name << '\t' << seed << '\t' << settled << '\t'
+                    << (settled ? found_iters : 0) << '\t' << (settled ? found_seconds : 0.0) << '\t'
+                    << move << '\n';
+            }
+        }
+        return stats;
+    }
+
+}  // namespace mcts